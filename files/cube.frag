@@ -1,29 +1,49 @@
 #version 150
 
+// feature flags are injected as #defines by l3d::gl::CubeShaderVariants:
+//   USE_TEXTURE_MIX    - animated mix between the pepper and bacon textures
+//   USE_WAVE           - wavy distortion of the texture coordinates
+//   USE_OVERRIDE_COLOR - multiplies the output by the overrideColor tint
+
 in vec4 FragColor;
 in vec2 TexCoord;
 
 out vec4 outColor;
 
+#ifdef USE_TEXTURE_MIX
 uniform float timeSinceStart;
 uniform sampler2D texPepper;
 uniform sampler2D texBacon;
+#endif
+
+#ifdef USE_OVERRIDE_COLOR
 uniform vec3 overrideColor;
+#endif
 
 void main() {
+  vec4 color = FragColor;
+
+#ifdef USE_TEXTURE_MIX
   float t = (sin(timeSinceStart * 4.0) + 1.0) * 0.5;
 
-  // recalculate coords to generate a mirrored wavy tex in the bottom half
   vec2 coord = TexCoord;
+#ifdef USE_WAVE
+  // recalculate coords to generate a mirrored wavy tex in the bottom half
   coord.x = coord.x + (sin(coord.y * 60 + timeSinceStart * 10.0) / 90.0);
+#endif
 
   // sample color from both textures
   vec4 colorPepper = texture(texPepper, coord);
   vec4 colorBacon = texture(texBacon, coord);
 
   // mixes both textures along the animation time
-  vec4 mixedColor = mix(colorPepper, colorBacon, t);
+  color *= mix(colorPepper, colorBacon, t);
+#endif
 
+#ifdef USE_OVERRIDE_COLOR
   // applies tinted color to output color
-  outColor = mixedColor * FragColor * vec4(overrideColor, 1.0);
-};
+  color *= vec4(overrideColor, 1.0);
+#endif
+
+  outColor = color;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <stb/stb_image.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Image.hpp"
+
+namespace l3d {
+namespace gl {
+
+// RGB8 pixels in top-down row order, as stored in image files.
+struct Snapshot {
+  int Width;
+  int Height;
+  std::vector<unsigned char> Pixels;
+};
+
+// Result of comparing two snapshots. Pixels count as different when any
+// channel is off by more than the tolerance given to CompareSnapshots.
+struct SnapshotDiff {
+  bool SizeMismatch;
+  std::size_t DifferentPixels;
+  int MaxChannelDelta;
+  double DifferentFraction;
+};
+
+// Reads the color buffer of the currently bound read framebuffer.
+inline Snapshot ReadFramebuffer(int width, int height) {
+  Snapshot snapshot{width, height, std::vector<unsigned char>()};
+  const std::size_t rowSize = static_cast<std::size_t>(width) * 3;
+  std::vector<unsigned char> bottomUp(rowSize * height);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, bottomUp.data());
+
+  // OpenGL returns rows bottom-up, flip them so the snapshot matches files
+  snapshot.Pixels.resize(bottomUp.size());
+  for (int y = 0; y < height; ++y)
+    std::copy(bottomUp.begin() + y * rowSize,
+              bottomUp.begin() + (y + 1) * rowSize,
+              snapshot.Pixels.begin() + (height - 1 - y) * rowSize);
+  return snapshot;
+}
+
+// Writes the snapshot as a binary PPM, which stb_image can load back.
+inline bool WriteSnapshot(const Snapshot& snapshot, const std::string& path) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) return false;
+  fprintf(file, "P6\n%d %d\n255\n", snapshot.Width, snapshot.Height);
+  const std::size_t written =
+      fwrite(snapshot.Pixels.data(), 1, snapshot.Pixels.size(), file);
+  fclose(file);
+  return written == snapshot.Pixels.size();
+}
+
+inline bool LoadSnapshot(const std::string& path, Snapshot& snapshot) {
+  Image image;
+  if (!image.Load(path.c_str(), STBI_rgb)) return false;
+  snapshot.Width = image.Width();
+  snapshot.Height = image.Height();
+  // channels reports the file's own channel count, the data is always RGB
+  const std::size_t size =
+      static_cast<std::size_t>(image.Width()) * image.Height() * 3;
+  snapshot.Pixels.assign(image.Bytes(), image.Bytes() + size);
+  return true;
+}
+
+inline SnapshotDiff CompareSnapshots(const Snapshot& actual,
+                                     const Snapshot& expected, int tolerance) {
+  SnapshotDiff diff{false, 0, 0, 0.0};
+  if (actual.Width != expected.Width || actual.Height != expected.Height) {
+    diff.SizeMismatch = true;
+    diff.DifferentFraction = 1.0;
+    return diff;
+  }
+  assert(actual.Pixels.size() == expected.Pixels.size() &&
+         "Snapshot data doesn't match its size!");
+
+  for (std::size_t i = 0; i < actual.Pixels.size(); i += 3) {
+    int pixelDelta = 0;
+    for (std::size_t c = 0; c < 3; ++c) {
+      const int delta = std::abs(static_cast<int>(actual.Pixels[i + c]) -
+                                 static_cast<int>(expected.Pixels[i + c]));
+      if (delta > pixelDelta) pixelDelta = delta;
+    }
+    if (pixelDelta > diff.MaxChannelDelta) diff.MaxChannelDelta = pixelDelta;
+    if (pixelDelta > tolerance) ++diff.DifferentPixels;
+  }
+  const std::size_t numPixels = actual.Pixels.size() / 3;
+  if (numPixels != 0)
+    diff.DifferentFraction =
+        static_cast<double>(diff.DifferentPixels) / numPixels;
+  return diff;
+}
+
+}  // namespace gl
+}  // namespace l3d
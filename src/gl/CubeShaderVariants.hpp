@@ -0,0 +1,144 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <cassert>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include "Shader.hpp"
+#include "ShaderProgram.hpp"
+
+namespace l3d {
+namespace gl {
+
+// Optional fragment stages of cube.frag. Each flag is compiled in as a
+// #define, so a variant only pays for the stages it was built with.
+enum CubeFeature : unsigned {
+  CubeTextureMix = 1u << 0,
+  CubeWave = 1u << 1,
+  CubeOverrideColor = 1u << 2,
+};
+
+const unsigned NumCubeFeatures = 3;
+
+// Vertex attribute locations of cube.vert, shared by every variant so a
+// single VAO setup is valid no matter which variant is bound.
+enum CubeAttribute : GLuint {
+  CubeAttribPosition = 0,
+  CubeAttribColor = 1,
+  CubeAttribTexCoord = 2,
+};
+
+// A linked cube shader permutation along with its uniform locations.
+// Uniforms that were compiled out of the variant have a location of -1.
+struct CubeShaderVariant {
+  ShaderProgram Program;
+  GLint Model;
+  GLint View;
+  GLint Proj;
+  GLint Time;
+  GLint OverrideColor;
+  GLint TexPepper;
+  GLint TexBacon;
+};
+
+// Material types pick their cube shader variant at compile time. The feature
+// mask doubles as the variant key, so looking a material up is a constant
+// index, and the flags let draw code skip uniforms the variant doesn't have.
+template <unsigned Features>
+struct CubeMaterial {
+  static_assert(Features < (1u << NumCubeFeatures), "Unknown cube feature!");
+  static_assert(!(Features & CubeWave) || (Features & CubeTextureMix),
+                "The wave distortion only applies to the texture mix!");
+  static const unsigned Variant = Features;
+  static const bool TextureMix = (Features & CubeTextureMix) != 0;
+  static const bool Wave = (Features & CubeWave) != 0;
+  static const bool OverrideColor = (Features & CubeOverrideColor) != 0;
+};
+
+// Compiles cube shader variants on first use and keeps them for the lifetime
+// of the cache. The vertex stage is identical for all variants and is
+// compiled only once.
+class CubeShaderVariants {
+ public:
+  static const unsigned NumVariants = 1u << NumCubeFeatures;
+
+  inline CubeShaderVariants(const std::string& vertPath,
+                            const std::string& fragPath);
+  CubeShaderVariants(const CubeShaderVariants&) = delete;
+  CubeShaderVariants& operator=(const CubeShaderVariants&) = delete;
+  inline CubeShaderVariant& Get(unsigned features);
+  template <class M>
+  inline CubeShaderVariant& Get();
+  inline static std::string Defines(unsigned features);
+
+ private:
+  inline std::unique_ptr<CubeShaderVariant> Compile(unsigned features);
+
+  Shader vertexShader;
+  std::string fragSource;
+  std::array<std::unique_ptr<CubeShaderVariant>, NumVariants> variants;
+};
+
+CubeShaderVariants::CubeShaderVariants(const std::string& vertPath,
+                                       const std::string& fragPath)
+    : vertexShader(GL_VERTEX_SHADER) {
+  vertexShader.SourceFromFile(vertPath);
+  vertexShader.Compile();
+
+  std::ifstream stream(fragPath);
+  assert(stream && "Unable to open file!");
+  fragSource.assign(std::istreambuf_iterator<GLchar>(stream),
+                    std::istreambuf_iterator<GLchar>());
+}
+
+CubeShaderVariant& CubeShaderVariants::Get(unsigned features) {
+  assert(features < NumVariants && "Unknown cube feature!");
+  std::unique_ptr<CubeShaderVariant>& variant = variants[features];
+  if (!variant) variant = Compile(features);
+  return *variant;
+}
+
+template <class M>
+CubeShaderVariant& CubeShaderVariants::Get() {
+  return Get(M::Variant);
+}
+
+std::string CubeShaderVariants::Defines(unsigned features) {
+  std::string defines;
+  if (features & CubeTextureMix) defines += "#define USE_TEXTURE_MIX\n";
+  if (features & CubeWave) defines += "#define USE_WAVE\n";
+  if (features & CubeOverrideColor) defines += "#define USE_OVERRIDE_COLOR\n";
+  return defines;
+}
+
+std::unique_ptr<CubeShaderVariant> CubeShaderVariants::Compile(
+    unsigned features) {
+  Shader fragShader(GL_FRAGMENT_SHADER);
+  fragShader.Source(fragSource, Defines(features));
+  fragShader.Compile();
+
+  std::unique_ptr<CubeShaderVariant> variant(new CubeShaderVariant());
+  ShaderProgram& prog = variant->Program;
+  prog.Attach(vertexShader);
+  prog.Attach(fragShader);
+  prog.BindAttribLocation("position", CubeAttribPosition);
+  prog.BindAttribLocation("color", CubeAttribColor);
+  prog.BindAttribLocation("texCoord", CubeAttribTexCoord);
+  prog.BindFragmentLocation("outColor", 0);
+  prog.Link();
+
+  variant->Model = prog.GetUniformLocation("model");
+  variant->View = prog.GetUniformLocation("view");
+  variant->Proj = prog.GetUniformLocation("proj");
+  variant->Time = prog.FindUniformLocation("timeSinceStart");
+  variant->OverrideColor = prog.FindUniformLocation("overrideColor");
+  variant->TexPepper = prog.FindUniformLocation("texPepper");
+  variant->TexBacon = prog.FindUniformLocation("texBacon");
+  return variant;
+}
+
+}  // namespace gl
+}  // namespace l3d
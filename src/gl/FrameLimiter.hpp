@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <cassert>
+#include <chrono>
+
+namespace l3d {
+namespace gl {
+
+// Bounds how many frames the CPU may queue ahead of the GPU. A fence is
+// inserted after every frame is submitted and, before a new frame starts,
+// the fence of the frame that would exceed the limit is waited on. Keeping
+// this at one frame trades some throughput for the lowest input latency.
+class FrameLimiter {
+ public:
+  static const int MaxFramesInFlight = 4;
+
+  inline explicit FrameLimiter(int framesInFlight);
+  inline ~FrameLimiter();
+  FrameLimiter(const FrameLimiter&) = delete;
+  FrameLimiter& operator=(const FrameLimiter&) = delete;
+  inline float BeginFrame();
+  inline void EndFrame();
+  inline int FramesInFlight() const;
+
+ private:
+  std::array<GLsync, MaxFramesInFlight> fences;
+  int framesInFlight;
+  int current;
+};
+
+FrameLimiter::FrameLimiter(int framesInFlight)
+    : framesInFlight(framesInFlight), current(0) {
+  assert(framesInFlight > 0 && framesInFlight <= MaxFramesInFlight &&
+         "Unsupported number of frames in flight!");
+  fences.fill(nullptr);
+}
+
+FrameLimiter::~FrameLimiter() {
+  for (GLsync fence : fences)
+    if (fence != nullptr) glDeleteSync(fence);
+}
+
+float FrameLimiter::BeginFrame() {
+  // returns how long, in seconds, the CPU was stalled waiting on the GPU
+  GLsync& fence = fences[current];
+  if (fence == nullptr) return 0.0f;
+
+  using std::chrono::high_resolution_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::duration;
+  const auto waitStart = high_resolution_clock::now();
+
+  // flushes on the first attempt so the fence is guaranteed to signal
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  const GLuint64 timeoutNs = 100000000;
+  GLenum status;
+  do {
+    status = glClientWaitSync(fence, flags, timeoutNs);
+    flags = 0;
+  } while (status == GL_TIMEOUT_EXPIRED);
+  assert(status != GL_WAIT_FAILED && "Unable to wait on frame fence!");
+
+  glDeleteSync(fence);
+  fence = nullptr;
+  return duration_cast<duration<float>>(high_resolution_clock::now() -
+                                        waitStart)
+      .count();
+}
+
+void FrameLimiter::EndFrame() {
+  GLsync& fence = fences[current];
+  assert(fence == nullptr && "EndFrame called without BeginFrame!");
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  assert(fence != nullptr && "Unable to create frame fence!");
+  current = (current + 1) % framesInFlight;
+}
+
+int FrameLimiter::FramesInFlight() const { return framesInFlight; }
+
+}  // namespace gl
+}  // namespace l3d
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cassert>
+
+namespace l3d {
+namespace gl {
+
+// Offscreen render target with an RGBA8 color and a depth-stencil
+// renderbuffer. Unlike the window's default framebuffer, its pixels are
+// always defined, so it can be read back even when the window is hidden.
+class Framebuffer {
+ public:
+  inline Framebuffer(int width, int height);
+  inline ~Framebuffer();
+  Framebuffer(const Framebuffer&) = delete;
+  Framebuffer& operator=(const Framebuffer&) = delete;
+  inline void Bind();
+  inline int Width() const;
+  inline int Height() const;
+  inline operator GLuint() const;
+
+ private:
+  GLuint fbo;
+  GLuint color;
+  GLuint depthStencil;
+  int width;
+  int height;
+};
+
+Framebuffer::Framebuffer(int width, int height)
+    : fbo(0), color(0), depthStencil(0), width(width), height(height) {
+  glGenFramebuffers(1, &fbo);
+  assert(fbo != 0 && "Unable to generate framebuffer!");
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+  glGenRenderbuffers(1, &color);
+  glBindRenderbuffer(GL_RENDERBUFFER, color);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, color);
+
+  glGenRenderbuffers(1, &depthStencil);
+  glBindRenderbuffer(GL_RENDERBUFFER, depthStencil);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, depthStencil);
+
+  assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE &&
+         "Incomplete framebuffer!");
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+Framebuffer::~Framebuffer() {
+  assert(fbo != 0 && "Attempt to destroy an invalid framebuffer!");
+  glDeleteFramebuffers(1, &fbo);
+  glDeleteRenderbuffers(1, &color);
+  glDeleteRenderbuffers(1, &depthStencil);
+}
+
+void Framebuffer::Bind() {
+  assert(fbo != 0 && "Attempt to bind an invalid framebuffer!");
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glViewport(0, 0, width, height);
+}
+
+int Framebuffer::Width() const { return width; }
+
+int Framebuffer::Height() const { return height; }
+
+Framebuffer::operator GLuint() const { return fbo; }
+
+}  // namespace gl
+}  // namespace l3d
@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 #include <cassert>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -12,9 +13,10 @@ class Shader {
  public:
   inline Shader(GLenum type);
   inline ~Shader();
-  inline void Source(std::string src);
+  inline void Source(const std::string& src);
+  inline void Source(const std::string& src, const std::string& defines);
   inline void Source(std::istream& src);
-  inline void SourceFromFile(std::string path);
+  inline void SourceFromFile(const std::string& path);
   inline bool Compile();
   inline operator GLuint() const;
 
@@ -34,10 +36,46 @@ Shader::~Shader() {
   glDeleteShader(shader);
 }
 
-void Shader::Source(std::string src) {
+void Shader::Source(const std::string& src) {
   assert(shader != 0 && "Attempt to provide source for invalid shader!");
-  const GLchar* glSrc = src.c_str();
-  glShaderSource(shader, 1, &glSrc, nullptr);
+  const GLchar* glSrc = src.data();
+  const GLint length = static_cast<GLint>(src.size());
+  glShaderSource(shader, 1, &glSrc, &length);
+}
+
+void Shader::Source(const std::string& src, const std::string& defines) {
+  assert(shader != 0 && "Attempt to provide source for invalid shader!");
+  // the #version directive must stay the first line of the shader, so the
+  // definitions are spliced in right after it
+  std::string::size_type split = 0;
+  const GLchar* separator = "";
+  if (src.compare(0, 8, "#version") == 0) {
+    split = src.find('\n');
+    if (split == std::string::npos) {
+      // the source is a lone #version line, terminate it before the defines
+      split = src.size();
+      separator = "\n";
+    } else {
+      ++split;
+    }
+  }
+  // restores the original line numbering after the defines, so compile
+  // errors point at the right line of the source file. From GLSL 3.30 on
+  // #line names the following line, before that it names the one above it
+  const int version = split != 0 ? std::atoi(src.c_str() + 8) : 110;
+  const int nextLine = split != 0 ? 2 : 1;
+  const std::string lineDirective =
+      "#line " + std::to_string(version >= 330 ? nextLine : nextLine - 1) +
+      "\n";
+
+  const GLchar* glSrc[5] = {src.data(), separator, defines.data(),
+                            lineDirective.data(), src.data() + split};
+  const GLint lengths[5] = {static_cast<GLint>(split),
+                            static_cast<GLint>(separator[0] != '\0'),
+                            static_cast<GLint>(defines.size()),
+                            static_cast<GLint>(lineDirective.size()),
+                            static_cast<GLint>(src.size() - split)};
+  glShaderSource(shader, 5, glSrc, lengths);
 }
 
 void Shader::Source(std::istream& src) {
@@ -46,7 +84,7 @@ void Shader::Source(std::istream& src) {
   Source(contents);
 }
 
-void Shader::SourceFromFile(std::string path) {
+void Shader::SourceFromFile(const std::string& path) {
   std::ifstream stream(path);
   assert(stream && "Unable to open file!");
   Source(stream);
@@ -16,6 +16,7 @@ class ShaderProgram {
   inline ~ShaderProgram();
   inline void Attach(GLuint shader);
   inline void BindFragmentLocation(const char* attr, int color);
+  inline void BindAttribLocation(const char* attr, GLuint index);
   inline bool Link();
   inline void Use();
   inline void VertexAttribPointerf(GLuint vao, const char* attr, int index,
@@ -28,6 +29,7 @@ class ShaderProgram {
   inline void SetUniform(GLint loc, const glm::mat4& value);
   inline void SetUniform(GLint loc, const glm::vec3& value);
   inline GLint GetUniformLocation(const char* name);
+  inline GLint FindUniformLocation(const char* name);
   inline operator GLuint() const;
 
  private:
@@ -55,6 +57,12 @@ void ShaderProgram::BindFragmentLocation(const char* attr, int color) {
   glBindFragDataLocation(prog, color, attr);
 }
 
+void ShaderProgram::BindAttribLocation(const char* attr, GLuint index) {
+  assert(prog != 0 &&
+         "Attempt to bind attribute location for invalid program!");
+  glBindAttribLocation(prog, index, attr);
+}
+
 bool ShaderProgram::Link() {
   assert(prog != 0 && "Attempt to link invalid program!");
   glLinkProgram(prog);
@@ -120,6 +128,13 @@ GLint ShaderProgram::GetUniformLocation(const char* name) {
   return loc;
 }
 
+GLint ShaderProgram::FindUniformLocation(const char* name) {
+  // unlike GetUniformLocation, a missing uniform is not an error and yields
+  // -1, as uniforms may be compiled out of some shader variants
+  assert(prog != 0 && "Attempt to get uniform location of an invalid program!");
+  return glGetUniformLocation(prog, name);
+}
+
 ShaderProgram::operator GLuint() const { return prog; }
 
 }  // namespace gl
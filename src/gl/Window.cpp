@@ -7,7 +7,7 @@ using l3d::gl::Window;
 using l3d::gl::ContextProperties;
 
 Window::Window(const char* title, int width, int height,
-               ContextProperties contextProp)
+               ContextProperties contextProp, bool visible)
     : Title(title),
       Width(width),
       Height(height),
@@ -27,6 +27,10 @@ Window::Window(const char* title, int width, int height,
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT,
                  ContextProp.ForwardCompatible ? GL_TRUE : GL_FALSE);
 
+  // hidden windows are meant for rendering into framebuffer objects, the
+  // contents of their default framebuffer are undefined
+  glfwWindowHint(GLFW_VISIBLE, visible ? GL_TRUE : GL_FALSE);
+
   Win = glfwCreateWindow(Width, Height, Title, nullptr, nullptr);
   glfwMakeContextCurrent(Win);
 
@@ -56,6 +60,21 @@ void Window::SwapBuffers() {
   glfwSwapBuffers(Win);
 }
 
+// A negative interval requests adaptive vsync: frames that miss the vertical
+// blank are presented immediately instead of waiting a whole extra refresh.
+// Falls back to regular vsync when the driver doesn't support it. Returns the
+// interval that was actually applied.
+int Window::SetSwapInterval(int interval) {
+  if (interval < 0 && !SupportsAdaptiveVsync()) interval = -interval;
+  glfwSwapInterval(interval);
+  return interval;
+}
+
+bool Window::SupportsAdaptiveVsync() const {
+  return glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+         glfwExtensionSupported("GLX_EXT_swap_control_tear");
+}
+
 bool Window::IsKeyPressed(int key) const {
   return glfwGetKey(Win, key) == GLFW_PRESS;
 }
@@ -15,11 +15,13 @@ struct ContextProperties {
 class Window {
 public:
   Window(const char* title, int width, int height,
-         ContextProperties contextProp);
+         ContextProperties contextProp, bool visible = true);
   virtual ~Window();
   void Close();
   void PollEvents();
   void SwapBuffers();
+  int SetSwapInterval(int interval);
+  bool SupportsAdaptiveVsync() const;
   bool IsKeyPressed(int key) const;
   bool IsOpen() const;
 
@@ -3,21 +3,65 @@
 #include <stb/stb_image.h>
 #include <array>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <memory>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/vec3.hpp>
 #include <streambuf>
 #include <string>
+#include <vector>
+#include "gl/Capture.hpp"
+#include "gl/CubeShaderVariants.hpp"
 #include "gl/Debug.hpp"
+#include "gl/FrameLimiter.hpp"
+#include "gl/Framebuffer.hpp"
 #include "gl/Image.hpp"
 #include "gl/Shader.hpp"
 #include "gl/ShaderProgram.hpp"
 #include "gl/VertexArray.hpp"
 #include "gl/VertexBuffer.hpp"
 #include "gl/Window.hpp"
+#include "mem/AllocStats.hpp"
+#include "mem/LinearArena.hpp"
+#include "mem/Pool.hpp"
+#include "regression/Checks.hpp"
+#include "regression/Options.hpp"
+#include "timing/FrameTimer.hpp"
+#include "timing/LatencyMetrics.hpp"
+#include "timing/TimingHistory.hpp"
+
+// how a draw interacts with the stencil buffer used for planar reflections
+enum class StencilPass { None, Write, Test };
+
+// materials used by the scene, each only enabling the fragment stages it
+// needs: the plane is plain vertex color and only the reflection is tinted
+using SolidCubeMaterial =
+    l3d::gl::CubeMaterial<l3d::gl::CubeTextureMix | l3d::gl::CubeWave>;
+using PlaneMaterial = l3d::gl::CubeMaterial<0>;
+using ReflectionMaterial =
+    l3d::gl::CubeMaterial<l3d::gl::CubeTextureMix | l3d::gl::CubeWave |
+                          l3d::gl::CubeOverrideColor>;
+
+struct DrawCommand;
+using ApplyMaterialFn = void (*)(const DrawCommand& cmd, float time);
+
+// a single draw of the scene, kept for the whole run and only updated per
+// frame; the order to submit them in is recorded into the per-frame arena
+struct DrawCommand {
+  l3d::gl::CubeShaderVariant* variant;
+  ApplyMaterialFn applyMaterial;
+  GLint first;
+  GLsizei count;
+  glm::mat4 model;
+  glm::vec3 color;
+  StencilPass stencil;
+};
 
 GLuint createTextureFromFile(GLenum texture, const char* filename) {
   GLuint tex;
@@ -31,18 +75,94 @@ GLuint createTextureFromFile(GLenum texture, const char* filename) {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   l3d::gl::Image image(filename, STBI_rgb);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.Width(), image.Height(), 0,
-               GL_RGB, GL_UNSIGNED_BYTE, image.BytesCopy().data());
+               GL_RGB, GL_UNSIGNED_BYTE, image.Bytes());
   glGenerateMipmap(GL_TEXTURE_2D);
   l3d::gl::CheckErrors();
   return tex;
 }
 
-int main() {
-  // create glfw window
+// sets the uniforms that stay constant for the whole run of the viewer
+template <class M>
+void setupMaterial(l3d::gl::CubeShaderVariants& variants, const glm::mat4& view,
+                   const glm::mat4& proj) {
+  l3d::gl::CubeShaderVariant& variant = variants.Get<M>();
+  l3d::gl::ShaderProgram& prog = variant.Program;
+  prog.Use();
+  prog.SetUniform(variant.View, view);
+  prog.SetUniform(variant.Proj, proj);
+  if (M::TextureMix) {
+    prog.SetUniform(variant.TexPepper, 0);
+    prog.SetUniform(variant.TexBacon, 1);
+  }
+  l3d::gl::CheckErrors();
+}
+
+// uploads the per-draw uniforms, the material flags skip at compile time the
+// ones its variant was built without
+template <class M>
+void applyMaterial(const DrawCommand& cmd, float time) {
+  l3d::gl::ShaderProgram& prog = cmd.variant->Program;
+  prog.SetUniform(cmd.variant->Model, cmd.model);
+  if (M::TextureMix) prog.SetUniform(cmd.variant->Time, time);
+  if (M::OverrideColor) prog.SetUniform(cmd.variant->OverrideColor, cmd.color);
+}
+
+template <class M>
+DrawCommand makeDrawCommand(l3d::gl::CubeShaderVariants& variants, GLint first,
+                            GLsizei count, const glm::mat4& model,
+                            const glm::vec3& color, StencilPass stencil) {
+  return DrawCommand{&variants.Get<M>(), &applyMaterial<M>, first, count,
+                     model, color, stencil};
+}
+
+void submitDrawCommands(const DrawCommand* const* cmds, std::size_t numCmds,
+                        float time) {
+  const l3d::gl::CubeShaderVariant* bound = nullptr;
+  for (std::size_t i = 0; i < numCmds; ++i) {
+    const DrawCommand& cmd = *cmds[i];
+    if (cmd.variant != bound) {
+      cmd.variant->Program.Use();
+      bound = cmd.variant;
+    }
+    switch (cmd.stencil) {
+      case StencilPass::None:
+        glDisable(GL_STENCIL_TEST);
+        glDepthMask(GL_TRUE);
+        break;
+      case StencilPass::Write:
+        // marks covered pixels without occluding what is drawn behind them
+        glEnable(GL_STENCIL_TEST);
+        glStencilFunc(GL_ALWAYS, 1, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+        glStencilMask(0xFF);
+        glDepthMask(GL_FALSE);
+        glClear(GL_STENCIL_BUFFER_BIT);
+        break;
+      case StencilPass::Test:
+        // only draws where a previous Write pass left its mark
+        glEnable(GL_STENCIL_TEST);
+        glStencilFunc(GL_EQUAL, 1, 0xFF);
+        glStencilMask(0x00);
+        glDepthMask(GL_TRUE);
+        break;
+    }
+    cmd.applyMaterial(cmd, time);
+    glDrawArrays(GL_TRIANGLES, cmd.first, cmd.count);
+  }
+  glDisable(GL_STENCIL_TEST);
+}
+
+int main(int argc, char** argv) {
+  const l3d::regression::ViewerOptions options =
+      l3d::regression::ParseOptions(argc, argv);
+  const l3d::regression::RegressionOptions& regression = options.Regression;
+
+  // create glfw window, kept hidden when rendering for regression checks
   const int winWidth = 1280;
   const int winHeight = 720;
   const l3d::gl::ContextProperties ctx{4, 5, true, true};
-  l3d::gl::Window window("L3Dviewer", winWidth, winHeight, ctx);
+  l3d::gl::Window window("L3Dviewer", winWidth, winHeight, ctx,
+                         !regression.Enabled);
 
   // generates VAO to avoid having to reconfigure attributes every time we
   // switch the active shader program
@@ -109,26 +229,18 @@ int main() {
   vbo.Data(vertices);
   l3d::gl::CheckErrors();
 
-  // creates the vertex shader
-  l3d::gl::Shader vertexShader(GL_VERTEX_SHADER);
-  vertexShader.SourceFromFile("files/cube.vert");
-  vertexShader.Compile();
+  // shader permutations are compiled on demand, so only the variants the
+  // scene's materials ask for are ever built; they're requested upfront so
+  // the render loop never has to compile one
+  l3d::gl::CubeShaderVariants variants("files/cube.vert", "files/cube.frag");
+  variants.Get<SolidCubeMaterial>();
+  variants.Get<PlaneMaterial>();
+  variants.Get<ReflectionMaterial>();
   l3d::gl::CheckErrors();
 
-  // creates the fragment shader
-  l3d::gl::Shader fragShader(GL_FRAGMENT_SHADER);
-  fragShader.SourceFromFile("files/cube.frag");
-  fragShader.Compile();
-  l3d::gl::CheckErrors();
-
-  // create a shader program with both shaders from above
-  l3d::gl::ShaderProgram prog;
-  prog.Attach(vertexShader);
-  prog.Attach(fragShader);
-  prog.BindFragmentLocation("outColor", 0);
-  prog.Link();
-  prog.Use();
-  l3d::gl::CheckErrors();
+  // every variant binds attributes to the same locations, so the vertex
+  // layout can be set up through any of them
+  l3d::gl::ShaderProgram& prog = variants.Get<SolidCubeMaterial>().Program;
 
   // sets up position attribute for the shader program
   prog.VertexAttribPointerf(vao, "position", 0, 3, false, 8);
@@ -142,41 +254,32 @@ int main() {
   prog.VertexAttribPointerf(vao, "texCoord", 6, 2, false, 8);
   l3d::gl::CheckErrors();
 
-  // finds time uniform
-  const GLint timeLoc = prog.GetUniformLocation("timeSinceStart");
-  prog.SetUniform(timeLoc, 0.f);
-  l3d::gl::CheckErrors();
-
   GLuint helloTex = createTextureFromFile(GL_TEXTURE0, "files/hello.png");
   GLuint baconTex = createTextureFromFile(GL_TEXTURE1, "files/bacon.png");
 
-  prog.SetUniform("texPepper", 0);
-  prog.SetUniform("texBacon", 1);
-
-  GLint modelUni = prog.GetUniformLocation("model");
-
-  GLint viewUni = prog.GetUniformLocation("view");
   glm::mat4 view =
       glm::lookAt(glm::vec3(1.2f, 2.2f, 1.4f), glm::vec3(0.0f, 0.0f, 0.0f),
                   glm::vec3(0.0f, 0.0f, 1.0f));
-  prog.SetUniform(viewUni, view);
 
-  GLint projUni = prog.GetUniformLocation("proj");
   const float aspectRatio =
       static_cast<float>(winWidth) / static_cast<float>(winHeight);
   glm::mat4 proj =
       glm::perspective(glm::radians(45.0f), aspectRatio, 1.0f, 10.f);
-  prog.SetUniform(projUni, proj);
 
-  GLint colorUni = prog.GetUniformLocation("overrideColor");
+  setupMaterial<SolidCubeMaterial>(variants, view, proj);
+  setupMaterial<PlaneMaterial>(variants, view, proj);
+  setupMaterial<ReflectionMaterial>(variants, view, proj);
 
   // enable depth test
   glEnable(GL_DEPTH_TEST);
 
+  // presentation settings, see ParseOptions for the defaults
+  window.SetSwapInterval(options.SwapInterval);
+  l3d::gl::FrameLimiter frameLimiter(options.FramesInFlight);
+
   using std::chrono::high_resolution_clock;
   using std::chrono::duration_cast;
   using std::chrono::duration;
-  const auto start = high_resolution_clock::now();
 
   // variables necessary for rotating object when we press space
   const float xMaxAngSpeed = 180.0f;
@@ -184,28 +287,90 @@ int main() {
   float xAngSpeed = 0.0f;
   float xAng = 0.0f;
 
-  // time from previous frame
-  auto lastFrameTime = high_resolution_clock::now();
-  float deltaTime = 0.0f;
+  // provides a jitter-free deltaTime and tracks pacing metrics
+  l3d::timing::FrameTimer frameTimer;
+  l3d::timing::LatencyMetrics latency;
+  bool metricsKeyWasPressed = false;
+
+  // transient per-frame memory, rewound at the start of every frame so the
+  // loop never has to go through the heap
+  l3d::mem::LinearArena frameArena(4 * 1024);
+
+  // the cube, the reflective plane and the cube reflection; their model
+  // matrices are updated every frame
+  const glm::mat4 identity(1.0f);
+  l3d::mem::Pool<DrawCommand, 16> drawCommands;
+  DrawCommand* cubeCmd = drawCommands.Create(
+      makeDrawCommand<SolidCubeMaterial>(variants, 0, 36, identity,
+                                         glm::vec3(1.0f, 1.0f, 1.0f),
+                                         StencilPass::None));
+  DrawCommand* planeCmd = drawCommands.Create(makeDrawCommand<PlaneMaterial>(
+      variants, 36, 6, identity, glm::vec3(1.0f, 1.0f, 1.0f),
+      StencilPass::Write));
+  DrawCommand* reflectionCmd =
+      drawCommands.Create(makeDrawCommand<ReflectionMaterial>(
+          variants, 0, 36, identity, glm::vec3(0.3f, 0.3f, 0.3f),
+          StencilPass::Test));
+  unsigned long long frameCount = 0;
+
+  // regression mode results, reserved upfront to keep frames allocation-free
+  l3d::regression::RegressionResults results{
+      l3d::gl::Snapshot{0, 0, std::vector<unsigned char>()}, {}, 0, 0, 0, 0,
+      0};
+  for (std::vector<float>& ms : results.StageMs) ms.reserve(regression.Frames);
+
+  // heap allocations made by frames after the first, which is allowed to
+  // warm up lazily initialized state; checked by the regression run
+  std::size_t allocsAtFrameStart = 0;
+  auto countFrameAllocs = [&]() {
+    if (frameCount == 0) return;
+    results.SteadyStateAllocs +=
+        l3d::mem::GetAllocStats().Allocations - allocsAtFrameStart;
+  };
+
+  // regression mode renders into an offscreen framebuffer, as the contents of
+  // a hidden window's default framebuffer are undefined
+  std::unique_ptr<l3d::gl::Framebuffer> offscreen;
+  if (regression.Enabled) {
+    offscreen.reset(new l3d::gl::Framebuffer(winWidth, winHeight));
+    offscreen->Bind();
+  }
 
   // runs application loop
   while (window.IsOpen()) {
-    // sets OpenGL clear color
-    glClearColor(0.2f, 0.2f, 0.2f, 1.f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    frameArena.Reset();
+    allocsAtFrameStart = l3d::mem::GetAllocStats().Allocations;
 
-    // updates time uniform attribute
-    const auto totalTime = high_resolution_clock::now() - start;
-    const float time = duration_cast<duration<float>>(totalTime).count();
-    prog.SetUniform(timeLoc, time);
+    // blocks until the GPU is within the allowed number of frames
+    const float gpuWait = frameLimiter.BeginFrame();
+    frameTimer.Tick();
+    const float deltaTime = frameTimer.DeltaTime();
+    const float time =
+        regression.Enabled ? regression.Time : frameTimer.TimeSinceStart();
 
-    // updates deltaTime
-    const auto frameDuration = high_resolution_clock::now() - lastFrameTime;
-    deltaTime = duration_cast<duration<float>>(frameDuration).count();
-    lastFrameTime = high_resolution_clock::now();
+    // samples input as late as possible, right before it's used to render
+    window.PollEvents();
+    const auto inputSampleTime = high_resolution_clock::now();
+
+    // controls angular speed for the object x rotation, user input is
+    // ignored in regression mode to keep the rendered frame deterministic
+    if (!regression.Enabled && window.IsKeyPressed(GLFW_KEY_SPACE))
+      xAngSpeed += xAngAccel * deltaTime;
+    else
+      xAngSpeed -= xAngAccel * deltaTime;
+
+    xAngSpeed = glm::clamp(xAngSpeed, 0.0f, xMaxAngSpeed);
+    xAng += xAngSpeed * deltaTime;
+
+    if (window.IsKeyPressed(GLFW_KEY_ESCAPE)) window.Close();
+
+    // prints pacing metrics once per press of the M key
+    const bool metricsKeyPressed = window.IsKeyPressed(GLFW_KEY_M);
+    if (metricsKeyPressed && !metricsKeyWasPressed) latency.Print();
+    metricsKeyWasPressed = metricsKeyPressed;
 
     // sets up transformation matix
-    glm::mat4 model;
+    glm::mat4 model(1.0f);
 
     // constantly rotates the object on the Z axis
     model = glm::rotate(model, time * glm::radians(45.0f),
@@ -213,59 +378,76 @@ int main() {
 
     // smoothly rotates the object on the X axis based on user's input
     model = glm::rotate(model, glm::radians(xAng), glm::vec3(1.0f, 0.0f, 0.0f));
+    const auto updateDone = high_resolution_clock::now();
+
+    // records the draws in submission order, the reflection is mirrored
+    // below the plane
+    cubeCmd->model = model;
+    planeCmd->model = model;
+    reflectionCmd->model = glm::scale(
+        glm::translate(model, glm::vec3(0, 0, -1)), glm::vec3(1, 1, -1));
+    const std::size_t numCmds = 3;
+    const DrawCommand** cmds = frameArena.NewArray<const DrawCommand*>(numCmds);
+    cmds[0] = cubeCmd;
+    cmds[1] = planeCmd;
+    cmds[2] = reflectionCmd;
+    const auto recordDone = high_resolution_clock::now();
 
-    // uploads model matrix to our uniform attribute
-    prog.SetUniform(modelUni, model);
-
-    // reset color override
-    prog.SetUniform(colorUni, glm::vec3(1.0f, 1.0f, 1.0f));
-
-    // draw cube
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-
-    // enables stencil test to implement planar reflections
-    glEnable(GL_STENCIL_TEST);
-
-    // draw plane
-    glStencilFunc(GL_ALWAYS, 1, 0xFF);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-    glStencilMask(0xFF);
-    glDepthMask(GL_FALSE);
-    glClear(GL_STENCIL_BUFFER_BIT);
-
-    glDrawArrays(GL_TRIANGLES, 36, 6);
-
-    // draw cube reflection
-    glStencilFunc(GL_EQUAL, 1, 0xFF);
-    glStencilMask(0x00);
-    glDepthMask(GL_TRUE);
-
-    model = glm::scale(glm::translate(model, glm::vec3(0, 0, -1)),
-                       glm::vec3(1, 1, -1));
-    prog.SetUniform(modelUni, model);
-
-    prog.SetUniform(colorUni, glm::vec3(0.3f, 0.3f, 0.3f));
-
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    // sets OpenGL clear color
+    glClearColor(0.2f, 0.2f, 0.2f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    submitDrawCommands(cmds, numCmds, time);
     l3d::gl::CheckErrors();
-
-    glDisable(GL_STENCIL_TEST);
+    const auto submitDone = high_resolution_clock::now();
+
+    if (regression.Enabled) {
+      // waits for the GPU so the frame time covers the actual rendering
+      glFinish();
+      const auto gpuDone = high_resolution_clock::now();
+      using Ms = duration<float, std::milli>;
+      std::array<std::vector<float>, l3d::timing::NumTimingStages>& stageMs =
+          results.StageMs;
+      using l3d::timing::TimingFrame;
+      using l3d::timing::TimingUpdate;
+      using l3d::timing::TimingRecord;
+      using l3d::timing::TimingSubmit;
+      stageMs[TimingFrame].push_back(
+          duration_cast<Ms>(gpuDone - inputSampleTime).count());
+      stageMs[TimingUpdate].push_back(
+          duration_cast<Ms>(updateDone - inputSampleTime).count());
+      stageMs[TimingRecord].push_back(
+          duration_cast<Ms>(recordDone - updateDone).count());
+      stageMs[TimingSubmit].push_back(
+          duration_cast<Ms>(submitDone - recordDone).count());
+      if (static_cast<int>(stageMs[TimingFrame].size()) == regression.Frames) {
+        // the readback allocates, so the last frame is accounted before it
+        countFrameAllocs();
+        results.Snapshot =
+            l3d::gl::ReadFramebuffer(offscreen->Width(), offscreen->Height());
+        break;
+      }
+    }
 
     window.SwapBuffers();
+    frameLimiter.EndFrame();
 
-    window.PollEvents();
-    // controls angular speed for the object x rotation
-    if (window.IsKeyPressed(GLFW_KEY_SPACE))
-      xAngSpeed += xAngAccel * deltaTime;
-    else
-      xAngSpeed -= xAngAccel * deltaTime;
+    const float inputToSwap = duration_cast<duration<float>>(
+                                  high_resolution_clock::now() -
+                                  inputSampleTime)
+                                  .count();
+    latency.Record(frameTimer.RawDeltaTime(), inputToSwap, gpuWait);
 
-    xAngSpeed = glm::clamp(xAngSpeed, 0.0f, xMaxAngSpeed);
-    xAng += xAngSpeed * deltaTime;
-
-    if (window.IsKeyPressed(GLFW_KEY_ESCAPE)) window.Close();
+    countFrameAllocs();
+    ++frameCount;
   }
 
+  if (regression.Enabled) {
+    results.ArenaPeak = frameArena.Peak();
+    results.ArenaCapacity = frameArena.Capacity();
+    results.PoolSize = drawCommands.Size();
+    results.PoolCapacity = drawCommands.Capacity();
+    return l3d::regression::RunRegressionChecks(regression, results);
+  }
   return 0;
 }
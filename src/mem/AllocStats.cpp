@@ -0,0 +1,43 @@
+#include "AllocStats.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace l3d {
+namespace mem {
+namespace detail {
+std::atomic<std::size_t> numAllocations{0};
+std::atomic<std::size_t> numDeallocations{0};
+std::atomic<std::size_t> numBytesAllocated{0};
+}  // namespace detail
+}  // namespace mem
+}  // namespace l3d
+
+using l3d::mem::detail::numAllocations;
+using l3d::mem::detail::numDeallocations;
+using l3d::mem::detail::numBytesAllocated;
+
+void* operator new(std::size_t size) {
+  numAllocations.fetch_add(1, std::memory_order_relaxed);
+  numBytesAllocated.fetch_add(size, std::memory_order_relaxed);
+  // malloc(0) may legally return nullptr, but operator new must not
+  if (void* ptr = std::malloc(size != 0 ? size : 1)) return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void operator delete(void* ptr) noexcept {
+  if (ptr == nullptr) return;
+  numDeallocations.fetch_add(1, std::memory_order_relaxed);
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept { ::operator delete(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  ::operator delete(ptr);
+}
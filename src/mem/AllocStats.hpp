@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace l3d {
+namespace mem {
+
+// Process-wide counters fed by the global operator new/delete replacements
+// in AllocStats.cpp. Used to check that the render loop stays allocation-free.
+struct AllocStats {
+  std::size_t Allocations;
+  std::size_t Deallocations;
+  std::size_t BytesAllocated;
+};
+
+inline AllocStats GetAllocStats();
+
+namespace detail {
+extern std::atomic<std::size_t> numAllocations;
+extern std::atomic<std::size_t> numDeallocations;
+extern std::atomic<std::size_t> numBytesAllocated;
+}  // namespace detail
+
+AllocStats GetAllocStats() {
+  return AllocStats{detail::numAllocations.load(std::memory_order_relaxed),
+                    detail::numDeallocations.load(std::memory_order_relaxed),
+                    detail::numBytesAllocated.load(std::memory_order_relaxed)};
+}
+
+}  // namespace mem
+}  // namespace l3d
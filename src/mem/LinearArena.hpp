@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace l3d {
+namespace mem {
+
+// Bump allocator over a single buffer reserved at construction. Nothing is
+// freed individually: Reset() rewinds the whole arena at once, which makes it
+// a fit for per-frame and load-time scratch data. Only trivially destructible
+// types may be created in it since destructors are never run. Running out of
+// space aborts in every build type, callers never get a null pointer back.
+class LinearArena {
+ public:
+  inline explicit LinearArena(std::size_t capacity);
+  LinearArena(const LinearArena&) = delete;
+  LinearArena& operator=(const LinearArena&) = delete;
+  inline void* Allocate(std::size_t size, std::size_t alignment);
+  template <class T>
+  inline T* NewArray(std::size_t count);
+  inline void Reset();
+  inline std::size_t Peak() const;
+  inline std::size_t Capacity() const;
+
+ private:
+  [[noreturn]] inline void Exhausted(std::size_t size) const;
+
+  std::unique_ptr<unsigned char[]> buffer;
+  std::size_t capacity;
+  std::size_t offset;
+  std::size_t peak;
+};
+
+LinearArena::LinearArena(std::size_t capacity)
+    : buffer(new unsigned char[capacity]),
+      capacity(capacity),
+      offset(0),
+      peak(0) {}
+
+void* LinearArena::Allocate(std::size_t size, std::size_t alignment) {
+  assert(alignment != 0 && (alignment & (alignment - 1)) == 0 &&
+         "Alignment must be a power of two!");
+  const std::uintptr_t current =
+      reinterpret_cast<std::uintptr_t>(buffer.get()) + offset;
+  const std::size_t padding = (alignment - current % alignment) % alignment;
+  // compares against the space left instead of summing up the new offset,
+  // so huge sizes can't wrap around and pass the check
+  const std::size_t left = capacity - offset;
+  if (padding > left || size > left - padding) Exhausted(size);
+  offset += padding + size;
+  if (offset > peak) peak = offset;
+  return buffer.get() + (offset - size);
+}
+
+template <class T>
+T* LinearArena::NewArray(std::size_t count) {
+  static_assert(std::is_trivially_destructible<T>::value,
+                "Arena objects are never destroyed!");
+  // an element count whose byte size overflows can never fit
+  if (count > SIZE_MAX / sizeof(T)) Exhausted(SIZE_MAX);
+  T* array = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+  for (std::size_t i = 0; i < count; ++i) new (array + i) T();
+  return array;
+}
+
+void LinearArena::Reset() { offset = 0; }
+
+std::size_t LinearArena::Peak() const { return peak; }
+
+std::size_t LinearArena::Capacity() const { return capacity; }
+
+void LinearArena::Exhausted(std::size_t size) const {
+  std::fprintf(stderr,
+               "Linear arena out of memory: %zu bytes requested, %zu of %zu "
+               "in use\n",
+               size, offset, capacity);
+  std::abort();
+}
+
+}  // namespace mem
+}  // namespace l3d
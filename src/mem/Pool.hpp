@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace l3d {
+namespace mem {
+
+// Fixed-capacity object pool for long-lived, frequently recycled objects such
+// as scene nodes and draw commands. Storage is embedded in the pool and free
+// slots are chained through an intrusive free list, so Create/Destroy never
+// touch the heap. Running out of slots aborts in every build type.
+template <class T, std::size_t N>
+class Pool {
+ public:
+  inline Pool();
+  inline ~Pool();
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+  template <class... Args>
+  inline T* Create(Args&&... args);
+  inline void Destroy(T* obj);
+  inline std::size_t Size() const;
+  inline std::size_t Capacity() const;
+
+ private:
+  union Slot {
+    Slot* next;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  Slot slots[N];
+  bool live[N];
+  Slot* freeList;
+  std::size_t size;
+};
+
+template <class T, std::size_t N>
+Pool<T, N>::Pool() : freeList(nullptr), size(0) {
+  // chains slots in reverse so the first Create() returns slots[0]
+  for (std::size_t i = N; i > 0; --i) {
+    slots[i - 1].next = freeList;
+    live[i - 1] = false;
+    freeList = &slots[i - 1];
+  }
+}
+
+template <class T, std::size_t N>
+Pool<T, N>::~Pool() {
+  for (std::size_t i = 0; i < N; ++i)
+    if (live[i]) reinterpret_cast<T*>(&slots[i].storage)->~T();
+}
+
+template <class T, std::size_t N>
+template <class... Args>
+T* Pool<T, N>::Create(Args&&... args) {
+  if (freeList == nullptr) {
+    std::fprintf(stderr, "Pool exhausted: all %zu slots in use\n", N);
+    std::abort();
+  }
+  Slot* slot = freeList;
+  freeList = slot->next;
+  live[slot - slots] = true;
+  ++size;
+  return new (&slot->storage) T(std::forward<Args>(args)...);
+}
+
+template <class T, std::size_t N>
+void Pool<T, N>::Destroy(T* obj) {
+  if (obj == nullptr) return;
+  Slot* slot = reinterpret_cast<Slot*>(obj);
+  assert(slot >= slots && slot < slots + N && "Object not owned by pool!");
+  assert(live[slot - slots] && "Double destroy of pooled object!");
+  obj->~T();
+  live[slot - slots] = false;
+  slot->next = freeList;
+  freeList = slot;
+  --size;
+}
+
+template <class T, std::size_t N>
+std::size_t Pool<T, N>::Size() const {
+  return size;
+}
+
+template <class T, std::size_t N>
+std::size_t Pool<T, N>::Capacity() const {
+  return N;
+}
+
+}  // namespace mem
+}  // namespace l3d
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../gl/Capture.hpp"
+#include "../timing/TimingHistory.hpp"
+#include "Options.hpp"
+
+namespace l3d {
+namespace regression {
+
+// What a regression run produced: the last frame, the per-frame stage times
+// in milliseconds, the heap allocations made after the first frame and how
+// much of the preallocated frame arena and draw command pool was used.
+struct RegressionResults {
+  gl::Snapshot Snapshot;
+  std::array<std::vector<float>, timing::NumTimingStages> StageMs;
+  std::size_t SteadyStateAllocs;
+  std::size_t ArenaPeak;
+  std::size_t ArenaCapacity;
+  std::size_t PoolSize;
+  std::size_t PoolCapacity;
+};
+
+inline int RunRegressionChecks(const RegressionOptions& opt,
+                               const RegressionResults& results);
+
+// Checks the captured frame and timings, returns the process exit code.
+int RunRegressionChecks(const RegressionOptions& opt,
+                        const RegressionResults& results) {
+  const gl::Snapshot& snapshot = results.Snapshot;
+  const std::size_t numFrames = results.StageMs[0].size();
+  int rc = 0;
+  // the golden image only holds for the setup it was rendered with
+  std::printf("renderer: %s, %s, GLFW %s, glm %d.%d.%d.%d\n",
+              reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+              reinterpret_cast<const char*>(glGetString(GL_VERSION)),
+              glfwGetVersionString(), GLM_VERSION_MAJOR, GLM_VERSION_MINOR,
+              GLM_VERSION_PATCH, GLM_VERSION_REVISION);
+
+  // every frame after the first must render without touching the heap
+  std::printf("allocations: %zu in steady-state frames\n",
+              results.SteadyStateAllocs);
+  if (results.SteadyStateAllocs != 0) {
+    std::printf("Heap allocations found in steady-state frames\n");
+    rc = 1;
+  }
+  // reported to size the preallocated memory, running out of it aborts
+  std::printf("frame arena: %zu of %zu bytes at peak\n", results.ArenaPeak,
+              results.ArenaCapacity);
+  std::printf("draw command pool: %zu of %zu slots\n", results.PoolSize,
+              results.PoolCapacity);
+
+  const bool captured = !snapshot.Pixels.empty();
+  if (!captured) {
+    // the window was closed before the last frame could be read back
+    std::printf("Only %zu of %d frames were rendered, nothing was captured\n",
+                numFrames, opt.Frames);
+    rc = 1;
+  }
+
+  if (captured && opt.CapturePath != nullptr &&
+      !gl::WriteSnapshot(snapshot, opt.CapturePath)) {
+    std::printf("Unable to write capture to %s\n", opt.CapturePath);
+    rc = 1;
+  }
+
+  if (captured && opt.GoldenPath != nullptr) {
+    gl::Snapshot golden;
+    if (!gl::LoadSnapshot(opt.GoldenPath, golden)) {
+      std::printf("Unable to load golden image %s\n", opt.GoldenPath);
+      rc = 1;
+    } else {
+      const gl::SnapshotDiff diff =
+          gl::CompareSnapshots(snapshot, golden, opt.Tolerance);
+      std::printf("image: %zu pixels differ (%.4f%%), max channel delta %d\n",
+                  diff.DifferentPixels, diff.DifferentFraction * 100.0,
+                  diff.MaxChannelDelta);
+      if (diff.SizeMismatch) {
+        std::printf("Image size %dx%d doesn't match golden %dx%d\n",
+                    snapshot.Width, snapshot.Height, golden.Width,
+                    golden.Height);
+        rc = 1;
+      } else if (diff.DifferentFraction > opt.MaxDiff) {
+        std::printf("Image differs from golden beyond tolerance\n");
+        rc = 1;
+      }
+    }
+  }
+
+  timing::TimingSample sample;
+  std::printf("timings (median of %zu frames):", numFrames);
+  for (int stage = 0; stage < timing::NumTimingStages; ++stage) {
+    sample.Ms[stage] = timing::Median(results.StageMs[stage]);
+    std::printf(" %s %.3f ms", timing::TimingStageNames[stage],
+                sample.Ms[stage]);
+  }
+  std::printf("\n");
+
+  if (opt.HistoryPath != nullptr) {
+    // compares against the median of the last few recorded runs, with some
+    // absolute slack for the stages that only take microseconds
+    const std::size_t historyWindow = 10;
+    const float slackMs = 0.05f;
+    timing::TimingHistory history(opt.HistoryPath);
+    history.Load();
+    if (history.Empty()) {
+      // nothing to compare against, this run only seeds the history
+      std::printf("No timing history in %s yet, timing check skipped\n",
+                  opt.HistoryPath);
+    } else {
+      const timing::TimingSample baseline = history.Baseline(historyWindow);
+      std::printf("baseline:");
+      for (int stage = 0; stage < timing::NumTimingStages; ++stage)
+        std::printf(" %s %.3f ms", timing::TimingStageNames[stage],
+                    baseline.Ms[stage]);
+      std::printf("\n");
+    }
+    if (history.Regressed(sample, opt.Threshold, slackMs, historyWindow)) {
+      std::printf("Timings regressed beyond %.0f%% of the baseline\n",
+                  opt.Threshold * 100.0f);
+      rc = 1;
+    } else if (rc == 0 && !history.Append(sample)) {
+      // only passing runs are recorded so a broken or regressed run can't
+      // become part of the baseline
+      std::printf("Unable to append timings to %s\n", opt.HistoryPath);
+      rc = 1;
+    }
+  }
+  return rc;
+}
+
+}  // namespace regression
+}  // namespace l3d
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../gl/FrameLimiter.hpp"
+
+namespace l3d {
+namespace regression {
+
+// Settings for the deterministic regression mode, in which the scene is
+// rendered offscreen at a fixed time and checked against a golden image and
+// a history of previous timings. Meant to run on software GL (llvmpipe).
+struct RegressionOptions {
+  bool Enabled;
+  float Time;
+  int Frames;
+  const char* CapturePath;
+  const char* GoldenPath;
+  int Tolerance;
+  double MaxDiff;
+  const char* HistoryPath;
+  float Threshold;
+};
+
+// Command line settings of the viewer.
+struct ViewerOptions {
+  int SwapInterval;
+  int FramesInFlight;
+  RegressionOptions Regression;
+};
+
+inline long ParseLongArg(const char* arg, const char* value, long min,
+                         long max);
+inline double ParseDoubleArg(const char* arg, const char* value, double min,
+                             double max);
+inline ViewerOptions ParseOptions(int argc, char** argv);
+
+// Parses a whole argument value as a number in [min, max], exits with an
+// error for anything else.
+long ParseLongArg(const char* arg, const char* value, long min, long max) {
+  char* end = nullptr;
+  errno = 0;
+  const long result = std::strtol(value, &end, 10);
+  if (errno != 0 || end == value || *end != '\0' || result < min ||
+      result > max) {
+    std::printf("Invalid value %s for argument %s, expected an integer in "
+                "[%ld, %ld]\n",
+                value, arg, min, max);
+    std::exit(2);
+  }
+  return result;
+}
+
+double ParseDoubleArg(const char* arg, const char* value, double min,
+                      double max) {
+  char* end = nullptr;
+  errno = 0;
+  const double result = std::strtod(value, &end);
+  if (errno != 0 || end == value || *end != '\0' || !std::isfinite(result) ||
+      result < min || result > max) {
+    std::printf(
+        "Invalid value %s for argument %s, expected a number in [%g, %g]\n",
+        value, arg, min, max);
+    std::exit(2);
+  }
+  return result;
+}
+
+// Any regression argument enables the regression mode. Exits with an error
+// on unknown arguments and invalid values.
+ViewerOptions ParseOptions(int argc, char** argv) {
+  ViewerOptions viewer;
+  // a negative swap interval asks for adaptive vsync and a single frame in
+  // flight keeps the CPU from queueing stale frames
+  viewer.SwapInterval = -1;
+  viewer.FramesInFlight = 1;
+  bool swapIntervalSet = false;
+
+  RegressionOptions& opt = viewer.Regression;
+  opt.Enabled = false;
+  opt.Time = 1.0f;
+  opt.Frames = 60;
+  opt.CapturePath = nullptr;
+  opt.GoldenPath = nullptr;
+  opt.Tolerance = 1;
+  opt.MaxDiff = 0.001;
+  opt.HistoryPath = nullptr;
+  opt.Threshold = 0.25f;
+
+  // every argument is a flag followed by its value
+  static const char* const flags[] = {
+      "--swap-interval", "--frames-in-flight", "--time",
+      "--frames",        "--capture",          "--golden",
+      "--tolerance",     "--max-diff",         "--history",
+      "--threshold"};
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    bool known = false;
+    for (const char* flag : flags)
+      known = known || std::strcmp(arg, flag) == 0;
+    if (!known) {
+      std::printf("Unknown argument %s\n", arg);
+      std::exit(2);
+    }
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (value == nullptr) {
+      std::printf("Missing value for argument %s\n", arg);
+      std::exit(2);
+    }
+    ++i;
+
+    if (std::strcmp(arg, "--swap-interval") == 0) {
+      viewer.SwapInterval = static_cast<int>(ParseLongArg(arg, value, -1, 4));
+      swapIntervalSet = true;
+      continue;
+    }
+    if (std::strcmp(arg, "--frames-in-flight") == 0) {
+      viewer.FramesInFlight = static_cast<int>(
+          ParseLongArg(arg, value, 1, gl::FrameLimiter::MaxFramesInFlight));
+      continue;
+    }
+
+    if (std::strcmp(arg, "--time") == 0)
+      opt.Time = static_cast<float>(ParseDoubleArg(arg, value, 0.0, 1e6));
+    else if (std::strcmp(arg, "--frames") == 0)
+      opt.Frames = static_cast<int>(ParseLongArg(arg, value, 1, 100000));
+    else if (std::strcmp(arg, "--capture") == 0)
+      opt.CapturePath = value;
+    else if (std::strcmp(arg, "--golden") == 0)
+      opt.GoldenPath = value;
+    else if (std::strcmp(arg, "--tolerance") == 0)
+      opt.Tolerance = static_cast<int>(ParseLongArg(arg, value, 0, 255));
+    else if (std::strcmp(arg, "--max-diff") == 0)
+      opt.MaxDiff = ParseDoubleArg(arg, value, 0.0, 1.0);
+    else if (std::strcmp(arg, "--history") == 0)
+      opt.HistoryPath = value;
+    else if (std::strcmp(arg, "--threshold") == 0)
+      opt.Threshold =
+          static_cast<float>(ParseDoubleArg(arg, value, 0.0, 100.0));
+    opt.Enabled = true;
+  }
+  // regression timings shouldn't be throttled by the display
+  if (opt.Enabled && !swapIntervalSet) viewer.SwapInterval = 0;
+  return viewer;
+}
+
+}  // namespace regression
+}  // namespace l3d
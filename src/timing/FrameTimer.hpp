@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace l3d {
+namespace timing {
+
+// Measures frame times and derives a smoothed delta time for simulation.
+// Raw deltas are clamped so a single hitch (window drag, breakpoint) can't
+// launch the simulation forward, and then blended into an exponential moving
+// average to filter out scheduler and present-time jitter.
+class FrameTimer {
+ public:
+  inline explicit FrameTimer(float smoothing = 0.1f, float maxDelta = 0.25f);
+  inline void Tick();
+  inline float DeltaTime() const;
+  inline float RawDeltaTime() const;
+  inline float TimeSinceStart() const;
+
+ private:
+  using Clock = std::chrono::high_resolution_clock;
+
+  Clock::time_point start;
+  Clock::time_point lastTick;
+  float smoothing;
+  float maxDelta;
+  float rawDelta;
+  float smoothedDelta;
+  float elapsed;
+  bool firstTick;
+};
+
+FrameTimer::FrameTimer(float smoothing, float maxDelta)
+    : start(Clock::now()),
+      lastTick(start),
+      smoothing(smoothing),
+      maxDelta(maxDelta),
+      rawDelta(0.0f),
+      smoothedDelta(0.0f),
+      elapsed(0.0f),
+      firstTick(true) {
+  assert(smoothing > 0.0f && smoothing <= 1.0f &&
+         "Smoothing factor must be in (0, 1]!");
+}
+
+void FrameTimer::Tick() {
+  using std::chrono::duration_cast;
+  using std::chrono::duration;
+  const Clock::time_point now = Clock::now();
+  rawDelta = duration_cast<duration<float>>(now - lastTick).count();
+  elapsed = duration_cast<duration<float>>(now - start).count();
+  lastTick = now;
+
+  const float clamped = std::min(rawDelta, maxDelta);
+  if (firstTick) {
+    // seeds the average instead of ramping up from zero
+    smoothedDelta = clamped;
+    firstTick = false;
+  } else {
+    smoothedDelta += (clamped - smoothedDelta) * smoothing;
+  }
+}
+
+float FrameTimer::DeltaTime() const { return smoothedDelta; }
+
+float FrameTimer::RawDeltaTime() const { return rawDelta; }
+
+float FrameTimer::TimeSinceStart() const { return elapsed; }
+
+}  // namespace timing
+}  // namespace l3d
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdio>
+
+namespace l3d {
+namespace timing {
+
+// Running averages of the numbers that matter when tuning frame pacing, all
+// in seconds. Kept as exponential moving averages so they can be sampled at
+// any time without storing a history. Input to swap ends when SwapBuffers
+// returns, which only matches presentation when the swap blocks on vsync.
+class LatencyMetrics {
+ public:
+  inline explicit LatencyMetrics(float smoothing = 0.05f);
+  inline void Record(float frameTime, float inputToSwap, float gpuWait);
+  inline float FrameTime() const;
+  inline float InputToSwap() const;
+  inline float GpuWait() const;
+  inline float MaxFrameTime() const;
+  inline void Print() const;
+
+ private:
+  float smoothing;
+  float frameTime;
+  float inputToSwap;
+  float gpuWait;
+  float maxFrameTime;
+  bool empty;
+};
+
+LatencyMetrics::LatencyMetrics(float smoothing)
+    : smoothing(smoothing),
+      frameTime(0.0f),
+      inputToSwap(0.0f),
+      gpuWait(0.0f),
+      maxFrameTime(0.0f),
+      empty(true) {}
+
+void LatencyMetrics::Record(float frameTime, float inputToSwap,
+                            float gpuWait) {
+  if (empty) {
+    this->frameTime = frameTime;
+    this->inputToSwap = inputToSwap;
+    this->gpuWait = gpuWait;
+    empty = false;
+  } else {
+    this->frameTime += (frameTime - this->frameTime) * smoothing;
+    this->inputToSwap += (inputToSwap - this->inputToSwap) * smoothing;
+    this->gpuWait += (gpuWait - this->gpuWait) * smoothing;
+  }
+  if (frameTime > maxFrameTime) maxFrameTime = frameTime;
+}
+
+float LatencyMetrics::FrameTime() const { return frameTime; }
+
+float LatencyMetrics::InputToSwap() const { return inputToSwap; }
+
+float LatencyMetrics::GpuWait() const { return gpuWait; }
+
+float LatencyMetrics::MaxFrameTime() const { return maxFrameTime; }
+
+void LatencyMetrics::Print() const {
+  printf(
+      "frame %.2f ms (max %.2f ms), input to swap %.2f ms, gpu wait %.2f "
+      "ms\n",
+      frameTime * 1000.0f, maxFrameTime * 1000.0f, inputToSwap * 1000.0f,
+      gpuWait * 1000.0f);
+}
+
+}  // namespace timing
+}  // namespace l3d
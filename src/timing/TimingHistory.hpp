@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace l3d {
+namespace timing {
+
+// Timed parts of a frame. Frame spans the whole frame up to GPU completion,
+// the others are the CPU stages it's made of.
+enum TimingStage : int {
+  TimingFrame = 0,
+  TimingUpdate,
+  TimingRecord,
+  TimingSubmit,
+  NumTimingStages
+};
+
+const char* const TimingStageNames[NumTimingStages] = {"frame", "update",
+                                                       "record", "submit"};
+
+// One line of the timing history, in milliseconds, indexed by TimingStage.
+struct TimingSample {
+  float Ms[NumTimingStages];
+};
+
+// Median of the given values, used to summarize both the frames of a run and
+// the runs in the history so a single noisy entry can't skew the baseline.
+inline float Median(std::vector<float> values) {
+  if (values.empty()) return 0.0f;
+  const std::size_t mid = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + mid, values.end());
+  return values[mid];
+}
+
+// Append-only history of timings, stored as one comma separated line of
+// TimingStage values per run.
+class TimingHistory {
+ public:
+  inline explicit TimingHistory(std::string path);
+  inline bool Load();
+  inline bool Append(const TimingSample& sample);
+  inline bool Regressed(const TimingSample& sample, float threshold,
+                        float slackMs, std::size_t window) const;
+  inline TimingSample Baseline(std::size_t window) const;
+  inline bool Empty() const;
+
+ private:
+  std::string path;
+  std::vector<TimingSample> samples;
+};
+
+TimingHistory::TimingHistory(std::string path) : path(std::move(path)) {}
+
+bool TimingHistory::Load() {
+  // a missing file is just an empty history
+  samples.clear();
+  std::ifstream stream(path);
+  if (!stream) return true;
+  std::string line;
+  while (std::getline(stream, line)) {
+    TimingSample sample;
+    if (sscanf(line.c_str(), "%f,%f,%f,%f", &sample.Ms[TimingFrame],
+               &sample.Ms[TimingUpdate], &sample.Ms[TimingRecord],
+               &sample.Ms[TimingSubmit]) == NumTimingStages)
+      samples.push_back(sample);
+  }
+  return !stream.bad();
+}
+
+bool TimingHistory::Append(const TimingSample& sample) {
+  std::ofstream stream(path, std::ios::app);
+  if (!stream) return false;
+  for (int stage = 0; stage < NumTimingStages; ++stage)
+    stream << (stage != 0 ? "," : "") << sample.Ms[stage];
+  stream << '\n';
+  samples.push_back(sample);
+  return static_cast<bool>(stream);
+}
+
+// Baseline is the per-stage median of the most recent runs in the history.
+TimingSample TimingHistory::Baseline(std::size_t window) const {
+  const std::size_t count = std::min(window, samples.size());
+  TimingSample baseline;
+  std::vector<float> values;
+  for (int stage = 0; stage < NumTimingStages; ++stage) {
+    values.clear();
+    for (std::size_t i = samples.size() - count; i < samples.size(); ++i)
+      values.push_back(samples[i].Ms[stage]);
+    baseline.Ms[stage] = Median(values);
+  }
+  return baseline;
+}
+
+// A stage regresses when it exceeds the baseline by more than the relative
+// threshold plus an absolute slack, the latter keeping stages that only take
+// microseconds from failing on timer noise.
+bool TimingHistory::Regressed(const TimingSample& sample, float threshold,
+                              float slackMs, std::size_t window) const {
+  if (samples.empty()) return false;
+  const TimingSample baseline = Baseline(window);
+  for (int stage = 0; stage < NumTimingStages; ++stage) {
+    const float limit = baseline.Ms[stage] * (1.0f + threshold) + slackMs;
+    if (sample.Ms[stage] > limit) return true;
+  }
+  return false;
+}
+
+bool TimingHistory::Empty() const { return samples.empty(); }
+
+}  // namespace timing
+}  // namespace l3d